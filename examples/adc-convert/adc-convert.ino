@@ -0,0 +1,41 @@
+#include "AnalogReaderDMA.h"
+
+const int sample_rate = 8000;
+const int channels = 2;
+const int buffer_size = 1024;
+void writeData(int16_t *data, int sampleCount);
+// DMA with timer and defined sample rate
+AnalogReaderDMA adc(channels, TIM3, sample_rate, writeData, buffer_size);
+// conversion into millivolts
+ADCConverter converter(channels);
+float mv[buffer_size / 4];
+volatile bool is_ready = false;
+
+// data callback: convert the raw values to millivolts
+void writeData(int16_t *rec, int sampleCount){
+  converter.convert(rec, mv, sampleCount);
+  is_ready = true;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while(!Serial);
+
+  converter.setCalibration(0, 1.0, 0); // optional: gain and offset of channel 0
+  converter.setVdda(3300);             // optional: supply voltage in mV
+  adc.begin();  
+}
+
+void loop() {
+  // print the last frame
+  if (is_ready){
+    int frame = sizeof(mv) / sizeof(float) - channels;
+    for (int j=0; j<channels; j++){
+      Serial.print(mv[frame+j]);
+      Serial.print(" ");
+    }
+    Serial.println();
+    is_ready = false;
+    delay(100);
+  }
+}
@@ -0,0 +1,31 @@
+#include "AnalogReaderDMA.h"
+
+const int sample_rate = 8000;
+const int channels = 1;
+void writeData(int16_t *data, int sampleCount);
+// DMA with timer and defined sample rate
+AnalogReaderDMA adc(channels, TIM3, sample_rate, writeData, 1024);
+// 2 stages: 50 Hz notch and 3 kHz low pass
+ADCFilter filter(channels, 2, ADCFilter::Q31);
+volatile int16_t last_value = 0;
+
+// data callback: receives the filtered data
+void writeData(int16_t *rec, int sampleCount){
+  last_value = rec[sampleCount-1];
+}
+
+void setup() {
+  Serial.begin(115200);
+  while(!Serial);
+
+  filter.setCoefficients(0, ADCBiquadCoefficients::notch(sample_rate, 50));
+  filter.setCoefficients(1, ADCBiquadCoefficients::lowPass(sample_rate, 3000));
+  adc.setFilter(&filter);
+  adc.setCenterZero(true);
+  adc.begin();  
+}
+
+void loop() {
+  Serial.println(last_value);
+  delay(100);
+}
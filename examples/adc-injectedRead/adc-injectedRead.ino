@@ -0,0 +1,33 @@
+#include "AnalogReaderDMA.h"
+
+const int sample_rate = 8000;
+const int channels = 1;
+void writeData(int16_t *data, int sampleCount);
+// DMA with timer and defined sample rate: the regular scan is using PA0
+AnalogReaderDMA adc(channels, TIM3, sample_rate, writeData, 1024);
+ADCConverter converter(channels);
+
+// data callback
+void writeData(int16_t *rec, int sampleCount){
+}
+
+void setup() {
+  Serial.begin(115200);
+  while(!Serial);
+
+  // optional: fast injected conversions of the channels which are not in the regular scan (PA1)
+  adc.setInjectedSamplingTime(ADC_SAMPLETIME_3CYCLES);
+  adc.begin();  
+
+  // determine the supply voltage from the internal reference
+  converter.setVddaFromVrefint(adc.injectedReadVrefint());
+  Serial.print("VDDA: ");
+  Serial.println(converter.vdda());
+}
+
+void loop() {
+  // fresh values while the DMA is running: PA0 keeps the regular sampling time
+  Serial.print(adc.injectedRead(PA0));
+  Serial.print(" ");
+  Serial.println(adc.injectedRead(PA1));
+}
@@ -0,0 +1,212 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#if defined(__ARM_FEATURE_DSP)
+#include "cmsis_compiler.h"
+#include <arm_acle.h>
+#endif
+
+#ifndef ADC_MAX_CHANNELS
+#define ADC_MAX_CHANNELS 8
+#endif
+
+// Max supported calibration gain (limited by the fixed point microvolt coefficients)
+#ifndef ADC_CONVERTER_MAX_GAIN
+#define ADC_CONVERTER_MAX_GAIN 32.0f
+#endif
+
+// Supported analog supply voltage range in mV (see the STM32F411 datasheet)
+#ifndef ADC_CONVERTER_MIN_VDDA
+#define ADC_CONVERTER_MIN_VDDA 1700.0f
+#endif
+#ifndef ADC_CONVERTER_MAX_VDDA
+#define ADC_CONVERTER_MAX_VDDA 3600.0f
+#endif
+
+// Factory calibration of the internal reference (measured at VDDA=3.3V) - see RM0383 / DS10314
+#ifndef VREFINT_CAL_ADDR
+#define VREFINT_CAL_ADDR ((uint16_t*) (0x1FFF7A2AU))
+#endif
+#ifndef VREFINT_CAL_VREF
+#define VREFINT_CAL_VREF (3300U)
+#endif
+
+/**
+ * @brief Converts the raw 12 bit right aligned ADC values of a DMA block into the requested output format.
+ * The per channel gain/offset calibration and the scaling are applied in one single pass:
+ *
+ * - int16_t: Q15 centered around the middle of the ADC range (e.g. for audio)
+ * - int32_t: calibrated microvolts (e.g. for accumulation)
+ * - float: calibrated millivolts
+ *
+ * The calibrated value is calculated as (raw - offset) * gain. The data is expected to be interleaved
+ * and to start with channel 0 (which is the case for the blocks provided by the AnalogReaderDMA callback).
+ * Do not combine this with setCenterZero(true) because the data is then not raw any more!
+ */
+class ADCConverter {
+  public:
+    ADCConverter(int channels){
+        channel_cnt = channels > ADC_MAX_CHANNELS ? ADC_MAX_CHANNELS : channels;
+        for (int ch=0; ch<ADC_MAX_CHANNELS; ch++){
+            gain[ch] = 1.0f;
+            offset[ch] = 0.0f;
+        }
+        updateCoefficients();
+    }
+
+    /// Defines the calibration for the indicated channel: calibrated = (raw - offset) * gain. The gain must be within +-ADC_CONVERTER_MAX_GAIN
+    bool setCalibration(int ch, float gainValue, float offsetValue=0.0f){
+        if (ch<0 || ch>=channel_cnt) return false;
+        if (fabsf(gainValue)>ADC_CONVERTER_MAX_GAIN) return false;
+        float old_gain = gain[ch];
+        float old_offset = offset[ch];
+        gain[ch] = gainValue;
+        offset[ch] = offsetValue;
+        if (!updateCoefficients()){
+            gain[ch] = old_gain;
+            offset[ch] = old_offset;
+            updateCoefficients();
+            return false;
+        }
+        return true;
+    }
+
+    /// Provides the gain of the indicated channel
+    float calibrationGain(int ch){
+        if (ch<0 || ch>=channel_cnt) return 0.0f;
+        return gain[ch];
+    }
+
+    /// Provides the offset (in ADC steps) of the indicated channel
+    float calibrationOffset(int ch){
+        if (ch<0 || ch>=channel_cnt) return 0.0f;
+        return offset[ch];
+    }
+
+    /// Defines the analog supply voltage (=ADC reference) in mV which is used for the int32_t and float output: values outside of ADC_CONVERTER_MIN_VDDA - ADC_CONVERTER_MAX_VDDA are rejected
+    bool setVdda(float mv){
+        if (!(mv>=ADC_CONVERTER_MIN_VDDA && mv<=ADC_CONVERTER_MAX_VDDA)) return false;
+        float old_vdda = vdda_mv;
+        vdda_mv = mv;
+        if (!updateCoefficients()){
+            vdda_mv = old_vdda;
+            updateCoefficients();
+            return false;
+        }
+        return true;
+    }
+
+    /// Calculates VDDA from a raw reading of the internal reference channel (ADC_CHANNEL_VREFINT) and the factory calibration: invalid readings are rejected
+    bool setVddaFromVrefint(uint16_t vrefintRaw){
+        if (vrefintRaw==0) return false;
+        return setVdda(static_cast<float>(VREFINT_CAL_VREF) * (*VREFINT_CAL_ADDR) / vrefintRaw);
+    }
+
+    /// Provides the actually defined analog supply voltage in mV
+    float vdda() {
+        return vdda_mv;
+    }
+
+    /// Provides the number of channels
+    int channels() {
+        return channel_cnt;
+    }
+
+    /// Converts the samples to Q15 centered around the middle of the ADC range (saturating)
+    void convert(const int16_t* in, int16_t* out, int samples){
+        int ch = 0;
+        int j = 0;
+#if defined(__ARM_FEATURE_DSP)
+        // 2 samples per 32 bit load: SMULWB/SMULWT multiply the halfwords of the pair directly with the Q16 gain
+        if ((((uintptr_t)in | (uintptr_t)out) & 3)==0){
+            for (; j+1<samples; j+=2){
+                int ch1 = ch+1>=channel_cnt ? 0 : ch+1;
+                int32_t pair;
+                memcpy(&pair, in+j, sizeof(pair));
+                int32_t lo = __SSAT(__smulwb(k_q15_dsp[ch], pair) + b_q15_dsp[ch], 16);
+                int32_t hi = __SSAT(__smulwt(k_q15_dsp[ch1], pair) + b_q15_dsp[ch1], 16);
+                uint32_t result = __PKHBT(lo, hi, 16);
+                memcpy(out+j, &result, sizeof(result));
+                ch = ch1+1>=channel_cnt ? 0 : ch1+1;
+            }
+        }
+#endif
+        for (; j<samples; j++){
+            out[j] = toQ15(in[j], ch);
+            if (++ch>=channel_cnt) ch = 0;
+        }
+    }
+
+    /// Converts the samples to calibrated microvolts
+    void convert(const int16_t* in, int32_t* out, int samples){
+        int ch = 0;
+        for (int j=0; j<samples; j++){
+            // 32x32->64 bit multiply accumulate (SMLAL on the Cortex-M4)
+            out[j] = (int32_t)(((int64_t)in[j] * k_uv[ch] + b_uv[ch]) >> 16);
+            if (++ch>=channel_cnt) ch = 0;
+        }
+    }
+
+    /// Converts the samples to calibrated millivolts
+    void convert(const int16_t* in, float* out, int samples){
+        int ch = 0;
+        for (int j=0; j<samples; j++){
+            out[j] = in[j] * k_mv[ch] + b_mv[ch];
+            if (++ch>=channel_cnt) ch = 0;
+        }
+    }
+
+  protected:
+    int channel_cnt;
+    float vdda_mv = VREFINT_CAL_VREF;
+    float gain[ADC_MAX_CHANNELS];
+    float offset[ADC_MAX_CHANNELS];
+    // precalculated coefficients: out = raw * k + b
+    int32_t k_q15[ADC_MAX_CHANNELS];
+    int64_t b_q15[ADC_MAX_CHANNELS];
+    // Q15 for the dual 16 bit kernel: out = ((raw * k) >> 16) + b
+    int32_t k_q15_dsp[ADC_MAX_CHANNELS];
+    int32_t b_q15_dsp[ADC_MAX_CHANNELS];
+    int32_t k_uv[ADC_MAX_CHANNELS];
+    int64_t b_uv[ADC_MAX_CHANNELS];
+    float k_mv[ADC_MAX_CHANNELS];
+    float b_mv[ADC_MAX_CHANNELS];
+
+    /// Q15 conversion of a single sample using Q12 coefficients
+    inline int32_t toQ15(int16_t raw, int ch){
+        // 64 bit multiply accumulate (SMLAL on the Cortex-M4): raw * k overflows 32 bits for gains above 8
+        int64_t result = ((int64_t)raw * k_q15[ch] + b_q15[ch]) >> 12;
+        if (result>32767) return 32767;
+        if (result<-32768) return -32768;
+        return (int32_t) result;
+    }
+
+    /// Calculates the fixed point and float coefficients from the calibration so that the kernels need only one multiply add: returns false if they do not fit
+    bool updateCoefficients() {
+        bool result = true;
+        for (int ch=0; ch<ADC_MAX_CHANNELS; ch++){
+            // Q15: ((raw - offset) * gain - 2048) * 16 in Q12
+            k_q15[ch] = lroundf(gain[ch] * 16.0f * 4096.0f);
+            b_q15[ch] = llroundf((-offset[ch] * gain[ch] * 16.0f - 32768.0f) * 4096.0f) + 2048;
+            // gain * 16 in Q16 (max 2^25) and the offset term which is limited so that the sum can not overflow
+            k_q15_dsp[ch] = lroundf(gain[ch] * 16.0f * 65536.0f);
+            double b_dsp = round(-offset[ch] * gain[ch] * 16.0 - 32768.0);
+            b_q15_dsp[ch] = (int32_t) fmax(-1.0e9, fmin(1.0e9, b_dsp));
+            // mV per step
+            float factor = gain[ch] * vdda_mv / 4095.0f;
+            k_mv[ch] = factor;
+            b_mv[ch] = -offset[ch] * factor;
+            // uV per step in Q16
+            double factor_uv = (double)gain[ch] * vdda_mv / 4095.0 * 1000.0 * 65536.0;
+            if (fabs(factor_uv)>INT32_MAX){
+                result = false;
+                factor_uv = 0.0;
+            }
+            k_uv[ch] = (int32_t) llround(factor_uv);
+            b_uv[ch] = llround(-offset[ch] * factor_uv) + 32768;
+        }
+        return result;
+    }
+
+};
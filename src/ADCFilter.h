@@ -0,0 +1,302 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+#if defined(__ARM_FEATURE_DSP)
+#include "cmsis_compiler.h"
+#endif
+
+#define ADC_FILTER_PI 3.14159265358979323846
+
+// Max change of the magnitude response caused by the coefficient quantization
+#ifndef ADC_FILTER_MAX_RESPONSE_ERROR
+#define ADC_FILTER_MAX_RESPONSE_ERROR 0.05
+#endif
+// Number of frequencies which are used to compare the magnitude response
+#ifndef ADC_FILTER_CHECK_POINTS
+#define ADC_FILTER_CHECK_POINTS 32
+#endif
+
+/**
+ * @brief Floating point coefficients of a biquad with a0 normalized to 1:
+ * y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]
+ * The helper methods are based on the Audio EQ Cookbook from Robert Bristow-Johnson.
+ */
+struct ADCBiquadCoefficients {
+    // double precision: float only resolves 24 bits which is not sufficient for Q30 coefficients
+    double b0 = 1.0;
+    double b1 = 0.0;
+    double b2 = 0.0;
+    double a1 = 0.0;
+    double a2 = 0.0;
+
+    /// Removes the indicated frequency (e.g. 50 or 60 Hz hum)
+    static ADCBiquadCoefficients notch(float sampleRate, float freq, float q=10.0f){
+        double cosw = cos(2.0 * ADC_FILTER_PI * freq / sampleRate);
+        double alpha = sin(2.0 * ADC_FILTER_PI * freq / sampleRate) / (2.0 * q);
+        return normalize(1.0, -2.0 * cosw, 1.0, 1.0 + alpha, -2.0 * cosw, 1.0 - alpha);
+    }
+
+    /// Low pass with the indicated cutoff frequency
+    static ADCBiquadCoefficients lowPass(float sampleRate, float freq, float q=0.7071f){
+        double cosw = cos(2.0 * ADC_FILTER_PI * freq / sampleRate);
+        double alpha = sin(2.0 * ADC_FILTER_PI * freq / sampleRate) / (2.0 * q);
+        return normalize((1.0 - cosw) / 2.0, 1.0 - cosw, (1.0 - cosw) / 2.0, 1.0 + alpha, -2.0 * cosw, 1.0 - alpha);
+    }
+
+    /// High pass with the indicated cutoff frequency
+    static ADCBiquadCoefficients highPass(float sampleRate, float freq, float q=0.7071f){
+        double cosw = cos(2.0 * ADC_FILTER_PI * freq / sampleRate);
+        double alpha = sin(2.0 * ADC_FILTER_PI * freq / sampleRate) / (2.0 * q);
+        return normalize((1.0 + cosw) / 2.0, -(1.0 + cosw), (1.0 + cosw) / 2.0, 1.0 + alpha, -2.0 * cosw, 1.0 - alpha);
+    }
+
+    /// Band pass around the indicated center frequency with a peak gain of 0 dB
+    static ADCBiquadCoefficients bandPass(float sampleRate, float freq, float q=1.0f){
+        double cosw = cos(2.0 * ADC_FILTER_PI * freq / sampleRate);
+        double alpha = sin(2.0 * ADC_FILTER_PI * freq / sampleRate) / (2.0 * q);
+        return normalize(alpha, 0.0, -alpha, 1.0 + alpha, -2.0 * cosw, 1.0 - alpha);
+    }
+
+  protected:
+    static ADCBiquadCoefficients normalize(double b0, double b1, double b2, double a0, double a1, double a2){
+        ADCBiquadCoefficients result;
+        result.b0 = b0 / a0;
+        result.b1 = b1 / a0;
+        result.b2 = b2 / a0;
+        result.a1 = a1 / a0;
+        result.a2 = a2 / a0;
+        return result;
+    }
+};
+
+/**
+ * @brief Cascade of fixed point Direct Form I biquads for each channel which filters the interleaved
+ * int16_t data of a DMA block in place. The filter state is kept across the blocks.
+ *
+ * - Q31 (default): coefficients in Q30 and an output state with 16 additional fractional bits
+ * - Q15: coefficients in Q14 with a 64 bit accumulator (__SMLALD on the Cortex-M4). This is faster, but
+ *   the Q14 coefficients can not represent filters with a low frequency relative to the sample rate:
+ *   e.g. a 50 Hz notch at 8000 Hz or 44100 Hz would not remove anything. setCoefficients() therefore
+ *   rejects coefficients where the quantization changes the magnitude response by more than
+ *   ADC_FILTER_MAX_RESPONSE_ERROR or where the filter would become unstable.
+ *
+ * The results are saturated to the int16_t range. The data is expected to start with channel 0.
+ */
+class ADCFilter {
+  public:
+    enum ADCFilterType {Q15, Q31};
+
+    ADCFilter(int channels, int stages=1, ADCFilterType type=Q31){
+        channel_cnt = channels;
+        stage_cnt = stages;
+        filter_type = type;
+        p_coef = new Coefficients[channel_cnt * stage_cnt]();
+        p_state = new State[channel_cnt * stage_cnt]();
+        // by default all stages pass the data unchanged
+        for (int j=0; j<channel_cnt * stage_cnt; j++){
+            p_coef[j].b0 = filter_type==Q15 ? 16384 : 1073741824;
+        }
+    }
+
+    ~ADCFilter(){
+        if (p_coef!=nullptr) delete[] p_coef;
+        if (p_state!=nullptr) delete[] p_state;
+    }
+
+    // we own the coefficient and state arrays
+    ADCFilter(const ADCFilter&) = delete;
+    ADCFilter& operator=(const ADCFilter&) = delete;
+
+    /// Defines the coefficients of the indicated stage for the indicated channel: returns false (and keeps the old coefficients) if they can not be represented with the selected precision
+    bool setCoefficients(int ch, int stage, const ADCBiquadCoefficients &coef){
+        if (ch<0 || ch>=channel_cnt || stage<0 || stage>=stage_cnt) return false;
+        double scale = filter_type==Q15 ? 16384.0 : 1073741824.0;
+        Coefficients c;
+        c.b0 = toFixed(coef.b0, scale);
+        c.b1 = toFixed(coef.b1, scale);
+        c.b2 = toFixed(coef.b2, scale);
+        // we store the negated feedback coefficients so that we only need to add
+        c.a1 = toFixed(-coef.a1, scale);
+        c.a2 = toFixed(-coef.a2, scale);
+        if (!isQuantizationValid(coef, c, scale)) return false;
+        p_coef[ch * stage_cnt + stage] = c;
+        return true;
+    }
+
+    /// Defines the coefficients of the indicated stage for all channels
+    bool setCoefficients(int stage, const ADCBiquadCoefficients &coef){
+        bool result = true;
+        for (int ch=0; ch<channel_cnt; ch++){
+            if (!setCoefficients(ch, stage, coef)) result = false;
+        }
+        return result;
+    }
+
+    /// Clears the filter state
+    void reset() {
+        for (int j=0; j<channel_cnt * stage_cnt; j++){
+            p_state[j] = State();
+        }
+    }
+
+    /// Provides the number of channels
+    int channels() {
+        return channel_cnt;
+    }
+
+    /// Provides the number of biquad stages per channel
+    int stages() {
+        return stage_cnt;
+    }
+
+    /// Filters the interleaved data in place
+    void process(int16_t* data, int samples){
+        for (int ch=0; ch<channel_cnt; ch++){
+            for (int stage=0; stage<stage_cnt; stage++){
+                int idx = ch * stage_cnt + stage;
+                if (filter_type==Q15){
+                    processQ15(p_coef[idx], p_state[idx], data + ch, samples - ch);
+                } else {
+                    processQ31(p_coef[idx], p_state[idx], data + ch, samples - ch);
+                }
+            }
+        }
+    }
+
+  protected:
+    struct Coefficients {
+        int32_t b0, b1, b2, a1, a2;
+    };
+    struct State {
+        int32_t x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    };
+    int channel_cnt;
+    int stage_cnt;
+    ADCFilterType filter_type;
+    Coefficients *p_coef = nullptr;
+    State *p_state = nullptr;
+
+    /// Converts a coefficient to fixed point (saturating)
+    int32_t toFixed(double value, double scale){
+        double max = filter_type==Q15 ? 32767.0 : 2147483647.0;
+        double result = round(value * scale);
+        if (result>max) result = max;
+        if (result<-max) result = -max;
+        return (int32_t) result;
+    }
+
+    /// Checks that the fixed point coefficients are stable and that the magnitude response does not change by more than ADC_FILTER_MAX_RESPONSE_ERROR
+    bool isQuantizationValid(const ADCBiquadCoefficients &coef, const Coefficients &c, double scale){
+        ADCBiquadCoefficients q;
+        q.b0 = c.b0 / scale;
+        q.b1 = c.b1 / scale;
+        q.b2 = c.b2 / scale;
+        q.a1 = -c.a1 / scale;
+        q.a2 = -c.a2 / scale;
+        // the poles must stay inside of the unit circle
+        if (q.a2>=1.0 || fabs(q.a1)>=1.0 + q.a2) return false;
+        // compare the response at the zero and pole frequencies (e.g. the notch) and on a logarithmic grid
+        double angles[ADC_FILTER_CHECK_POINTS + 2];
+        angles[0] = rootAngle(coef.b0, coef.b1, coef.b2);
+        angles[1] = rootAngle(1.0, coef.a1, coef.a2);
+        for (int j=0; j<ADC_FILTER_CHECK_POINTS; j++){
+            angles[j+2] = ADC_FILTER_PI * pow(10.0, -4.0 + 4.0 * j / (ADC_FILTER_CHECK_POINTS - 1));
+        }
+        for (int j=0; j<ADC_FILTER_CHECK_POINTS + 2; j++){
+            if (fabs(magnitude(q, angles[j]) - magnitude(coef, angles[j])) > ADC_FILTER_MAX_RESPONSE_ERROR) return false;
+        }
+        return true;
+    }
+
+    /// Provides the magnitude of the frequency response at the indicated angle (= 2 * ADC_FILTER_PI * freq / sampleRate)
+    double magnitude(const ADCBiquadCoefficients &coef, double angle){
+        double c1 = cos(angle), s1 = sin(angle);
+        double c2 = cos(2.0 * angle), s2 = sin(2.0 * angle);
+        double num_re = coef.b0 + coef.b1 * c1 + coef.b2 * c2;
+        double num_im = -coef.b1 * s1 - coef.b2 * s2;
+        double den_re = 1.0 + coef.a1 * c1 + coef.a2 * c2;
+        double den_im = -coef.a1 * s1 - coef.a2 * s2;
+        return sqrt((num_re * num_re + num_im * num_im) / (den_re * den_re + den_im * den_im));
+    }
+
+    /// Provides the angle of the complex root pair of x0 + x1*z^-1 + x2*z^-2 or 0 if the roots are real
+    double rootAngle(double x0, double x1, double x2){
+        if (x0 * x2 <= 0.0 || x1 * x1 >= 4.0 * x0 * x2) return 0.0;
+        return acos(-x1 / (2.0 * sqrt(x0 * x2)));
+    }
+
+    /// Q14 coefficients, int16_t state: every channel_cnt sample starting with data[0] is processed
+    void processQ15(Coefficients &c, State &s, int16_t* data, int n){
+#if defined(__ARM_FEATURE_DSP)
+        // pack the coefficients and the state into pairs for the dual 16 bit multiply accumulate
+        uint32_t b12 = __PKHBT(c.b1, c.b2, 16);
+        uint32_t a12 = __PKHBT(c.a1, c.a2, 16);
+        uint32_t xs = __PKHBT(s.x1, s.x2, 16);
+        uint32_t ys = __PKHBT(s.y1, s.y2, 16);
+        for (int j=0; j<n; j+=channel_cnt){
+            int32_t x0 = data[j];
+            int64_t acc = (int64_t)c.b0 * x0 + (1 << 13);
+            acc = __SMLALD(b12, xs, acc);
+            acc = __SMLALD(a12, ys, acc);
+            int32_t y0 = __SSAT((int32_t)(acc >> 14), 16);
+            xs = __PKHBT(x0, xs, 16);
+            ys = __PKHBT(y0, ys, 16);
+            data[j] = y0;
+        }
+        s.x1 = (int16_t) xs;
+        s.x2 = (int16_t) (xs >> 16);
+        s.y1 = (int16_t) ys;
+        s.y2 = (int16_t) (ys >> 16);
+#else
+        int32_t x1 = s.x1, x2 = s.x2, y1 = s.y1, y2 = s.y2;
+        for (int j=0; j<n; j+=channel_cnt){
+            int32_t x0 = data[j];
+            int64_t acc = (int64_t)c.b0 * x0 + (int64_t)c.b1 * x1 + (int64_t)c.b2 * x2
+                        + (int64_t)c.a1 * y1 + (int64_t)c.a2 * y2 + (1 << 13);
+            int32_t y0 = saturate((int32_t)(acc >> 14), 32767);
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            data[j] = y0;
+        }
+        s.x1 = x1;
+        s.x2 = x2;
+        s.y1 = y1;
+        s.y2 = y2;
+#endif
+    }
+
+    /// Q30 coefficients, int16_t input state and output state with 16 fractional bits
+    void processQ31(Coefficients &c, State &s, int16_t* data, int n){
+        int32_t x1 = s.x1, x2 = s.x2, y1 = s.y1, y2 = s.y2;
+        for (int j=0; j<n; j+=channel_cnt){
+            int32_t x0 = data[j];
+            // 32x32->64 bit multiply accumulate (SMLAL on the Cortex-M4)
+            int64_t acc = (int64_t)c.b0 * x0 + (int64_t)c.b1 * x1 + (int64_t)c.b2 * x2;
+            acc += ((int64_t)c.a1 * y1 + (int64_t)c.a2 * y2) >> 16;
+            // Q30 -> output with 16 fractional bits
+            acc = (acc + (1 << 13)) >> 14;
+            if (acc>0x7FFFFFFFLL) acc = 0x7FFFFFFFLL;
+            if (acc<-0x80000000LL) acc = -0x80000000LL;
+            int32_t y0 = (int32_t) acc;
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            // round to the nearest int16_t value
+            data[j] = saturate((int32_t)(((int64_t)y0 + 0x8000) >> 16), 32767);
+        }
+        s.x1 = x1;
+        s.x2 = x2;
+        s.y1 = y1;
+        s.y2 = y2;
+    }
+
+    inline int32_t saturate(int32_t value, int32_t max){
+        if (value>max) return max;
+        if (value<-max-1) return -max-1;
+        return value;
+    }
+
+};
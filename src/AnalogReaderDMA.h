@@ -10,6 +10,10 @@
 
 #undef Error_Handler
 #define ADC_MAX_CHANNELS 8
+// injected group has not been configured with any channel yet
+#define ADC_INJECTED_NONE 0xFFFFFFFFU
+#include "ADCConverter.h"
+#include "ADCFilter.h"
 
 // Callback handler vectors
 std::vector<std::function<void(ADC_HandleTypeDef*)>> list_HAL_ADC_MspInit;
@@ -269,6 +273,38 @@ class AnalogReaderDMA {
         return adc_result[lastFrameStartIdx+channel];
     }
 
+    /// Converts the indicated channel (0 - 7) or pin PA0 to PB0 with the injected group: this interrupts the regular DMA scan and provides a fresh value
+    int16_t injectedRead(int in){
+        int channel = in;
+        if (in>ADC_MAX_CHANNELS){
+            // channel contains pin
+            channel = getChannelForPin(in);
+        }
+        if (channel<0 || channel>=ADC_MAX_CHANNELS) {
+            STM32_LOG(Error, "requested channel %d not valid", channel);
+            return 0;
+        }
+        return injectedReadADCChannel(getADCChannel(channel));
+    }
+
+    /// Converts the internal reference voltage with the injected group: use the result with ADCConverter::setVddaFromVrefint()
+    int16_t injectedReadVrefint(){
+        return injectedReadADCChannel(ADC_CHANNEL_VREFINT);
+    }
+
+    /// Define the sampling time of the injected conversions e.g. ADC_SAMPLETIME_3CYCLES. The ADC stores the sampling time per channel
+    /// and not per group: so this is only used for channels which are not part of the regular scan, the others keep the samplingTime()
+    void setInjectedSamplingTime(uint32_t st){
+        injected_sampling_time = st;
+        // make sure that the next injectedRead() is using it
+        injected_adc_channel = ADC_INJECTED_NONE;
+    }
+
+    /// Provides the actually defined sampling time of the injected conversions
+    uint32_t injectedSamplingTime() {
+        return injected_sampling_time;
+    }
+
     /// We can correct the sampling rate if the effective data input does not match
     void setRateCorrectionFactor(float factor){
         correction_factor = factor;
@@ -294,6 +330,21 @@ class AnalogReaderDMA {
         is_center_zero = active;
     }
 
+    /// Defines a filter which is applied in place on each DMA block before the data is provided via the callback: call before begin(). The filter must have the same number of channels!
+    bool setFilter(ADCFilter *filter){
+        if (filter!=nullptr && filter->channels()!=channel_cnt) {
+            STM32_LOG(Error, "filter channels %d do not match %d", filter->channels(), channel_cnt);
+            return false;
+        }
+        p_filter = filter;
+        return true;
+    }
+
+    /// Provides the actually defined filter
+    ADCFilter* filter() {
+        return p_filter;
+    }
+
     /// Returns true if the values are normlized around 0
     bool isCenterZero() {
         return is_center_zero;
@@ -311,6 +362,9 @@ protected:
     int sample_rate=0;
     int lastFrameStartIdx=0;
     uint32_t sampling_time = ADC_SAMPLETIME_28CYCLES; // ADC_SAMPLETIME_3CYCLES ADC_SAMPLETIME_15CYCLES ADC_SAMPLETIME_28CYCLES ADC_SAMPLETIME_144CYCLES;
+    uint32_t injected_sampling_time = ADC_SAMPLETIME_15CYCLES;
+    uint32_t injected_adc_channel = ADC_INJECTED_NONE;
+    uint32_t injected_timeout_ms = 2;
     uint8_t* adc_buffer = nullptr;
     uint16_t adc_buffer_size = 0;
     volatile int16_t *adc_result = nullptr; 
@@ -318,6 +372,7 @@ protected:
     DMA_HandleTypeDef hdma_adc1;
     TcallbackADC adc_callback = nullptr;
     ADCAverageCalculator *p_avg = nullptr;
+    ADCFilter *p_filter = nullptr;
 
     const std::function<void(ADC_HandleTypeDef*)> f_HAL_ADC_MspInit=std::bind(&AnalogReaderDMA::HAL_ADC_MspInit, this, std::placeholders::_1);
     const std::function<void(ADC_HandleTypeDef*)> f_HAL_ADC_MspDeInit=std::bind(&AnalogReaderDMA::HAL_ADC_MspDeInit, this, std::placeholders::_1);
@@ -345,6 +400,12 @@ protected:
         return result;
     }
 
+    /// Determines the ADC channel for the indicated channel index (0 - 7)
+    uint32_t getADCChannel(int channel){
+        static const uint32_t adc_channels[] = {ADC_CHANNEL_0, ADC_CHANNEL_1, ADC_CHANNEL_3, ADC_CHANNEL_4, ADC_CHANNEL_5, ADC_CHANNEL_6, ADC_CHANNEL_7, ADC_CHANNEL_8};
+        return adc_channels[channel];
+    }
+
     /// Determines the channel for the indicated pin  
     int getChannelForPin(int pin){
         int channel = -1;
@@ -469,16 +530,77 @@ protected:
             Error_Handler();
         }
 
-        int adc_channels[] = {ADC_CHANNEL_0, ADC_CHANNEL_1, ADC_CHANNEL_3, ADC_CHANNEL_4, ADC_CHANNEL_5, ADC_CHANNEL_6, ADC_CHANNEL_6, ADC_CHANNEL_7, ADC_CHANNEL_8};
         // Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
         for (int ch=0; ch < channels(); ch++){
-            sConfig.Channel = adc_channels[ch];
+            sConfig.Channel = getADCChannel(ch);
             sConfig.Rank = ch+1;
             sConfig.SamplingTime = sampling_time; 
             if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK){
                 Error_Handler();
             }
         }
+
+        // The injected group is configured with the first injectedRead(): configuring a channel now would overwrite its regular sampling time
+        injected_adc_channel = ADC_INJECTED_NONE;
+
+        // Enable the internal reference and wait for its startup time (t_START max 10us) so that the first injectedReadVrefint() is valid
+        ADC->CCR |= ADC_CCR_TSVREFE;
+        delayMicroseconds(10);
+    }
+
+    /// Determines the sampling time for the injected conversion of the indicated channel
+    uint32_t getInjectedSamplingTime(uint32_t adcChannel){
+        // the internal reference needs a sampling time of at least 10us
+        if (adcChannel==ADC_CHANNEL_VREFINT) return ADC_SAMPLETIME_480CYCLES;
+        // the sampling time is stored per channel: we must not change it for the regular scan
+        for (int ch=0; ch<channels(); ch++){
+            if (getADCChannel(ch)==adcChannel) return sampling_time;
+        }
+        return injected_sampling_time;
+    }
+
+    /// Configures the channel of the injected group (rank 1): 1 conversion started by software which preempts the regular scan
+    bool configInjectedChannel(uint32_t adcChannel){
+        ADC_InjectionConfTypeDef sConfigInjected = {0};
+        sConfigInjected.InjectedChannel = adcChannel;
+        sConfigInjected.InjectedRank = 1;
+        sConfigInjected.InjectedNbrOfConversion = 1;
+        sConfigInjected.InjectedSamplingTime = getInjectedSamplingTime(adcChannel);
+        sConfigInjected.InjectedOffset = 0;
+        sConfigInjected.ExternalTrigInjecConvEdge = ADC_EXTERNALTRIGINJECCONVEDGE_NONE;
+        sConfigInjected.ExternalTrigInjecConv = ADC_INJECTED_SOFTWARE_START;
+        sConfigInjected.AutoInjectedConv = DISABLE;
+        sConfigInjected.InjectedDiscontinuousConvMode = DISABLE;
+        if (HAL_ADCEx_InjectedConfigChannel(&hadc1, &sConfigInjected) != HAL_OK){
+            return false;
+        }
+        injected_adc_channel = adcChannel;
+        return true;
+    }
+
+    /// Starts an injected conversion of the indicated ADC channel and waits for the result
+    int16_t injectedReadADCChannel(uint32_t adcChannel){
+        if (!is_active) {
+            STM32_LOG(Error, "not active");
+            return 0;
+        }
+        // we only need to reconfigure if the channel has changed
+        if (adcChannel!=injected_adc_channel && !configInjectedChannel(adcChannel)){
+            STM32_LOG(Error, "injected config failed");
+            return 0;
+        }
+        if (HAL_ADCEx_InjectedStart(&hadc1) != HAL_OK){
+            STM32_LOG(Error, "injected start failed");
+            return 0;
+        }
+        int16_t result = 0;
+        if (HAL_ADCEx_InjectedPollForConversion(&hadc1, injected_timeout_ms) == HAL_OK){
+            result = HAL_ADCEx_InjectedGetValue(&hadc1, ADC_INJECTED_RANK_1);
+        } else {
+            STM32_LOG(Error, "injected timeout");
+        }
+        // we do not call HAL_ADCEx_InjectedStop() because the ADC must stay enabled for the regular DMA conversion
+        return result;
     }
 
     /**
@@ -518,6 +640,7 @@ protected:
         adc_result = start;
         if (adc_callback!=nullptr) {
             p_avg->update(start,len_samples);
+            if (p_filter!=nullptr) p_filter->process(start,len_samples);
             adc_callback(start, len_samples);
         }
     }
@@ -536,6 +659,7 @@ protected:
         adc_result = start;
         if (adc_callback!=nullptr){
             p_avg->update(start,len_samples);
+            if (p_filter!=nullptr) p_filter->process(start,len_samples);
             adc_callback(start, len_samples);
         } 
     }
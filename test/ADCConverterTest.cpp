@@ -0,0 +1,94 @@
+// Host test of the ADCConverter against a double precision reference
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+static uint16_t vrefint_cal = 1500;
+#define VREFINT_CAL_ADDR (&vrefint_cal)
+#include "ADCConverter.h"
+#include "Benchmark.h"
+
+const int channels = 3;
+const int samples = 512 * channels;
+static int16_t raw[samples];
+static int16_t q15[samples];
+static int32_t uv[samples];
+static float mv[samples];
+
+/// calibrated value in ADC steps
+double reference(ADCConverter &conv, int16_t value, int ch){
+    return (value - conv.calibrationOffset(ch)) * conv.calibrationGain(ch);
+}
+
+void testConversion(ADCConverter &conv){
+    conv.convert(raw, q15, samples);
+    conv.convert(raw, uv, samples);
+    conv.convert(raw, mv, samples);
+    for (int j=0; j<samples; j++){
+        int ch = j % channels;
+        double c = reference(conv, raw[j], ch);
+        double q = fmin(32767.0, fmax(-32768.0, round((c - 2048.0) * 16.0)));
+        double ref_mv = c * conv.vdda() / 4095.0;
+        TEST_CHECK(fabs(q15[j] - q) <= 1.0, "q15 %d: %d != %f", j, q15[j], q);
+        TEST_CHECK(fabs(uv[j] - ref_mv * 1000.0) <= 2.0, "uv %d: %d != %f", j, uv[j], ref_mv * 1000.0);
+        TEST_CHECK(fabs(mv[j] - ref_mv) <= 1e-3 + fabs(ref_mv) * 1e-5, "mv %d: %f != %f", j, mv[j], ref_mv);
+    }
+}
+
+int main(){
+    srand(1);
+    for (int j=0; j<samples; j++){
+        raw[j] = rand() % 4096;
+    }
+    raw[0] = 0;
+    raw[1] = 4095;
+
+    // default calibration
+    ADCConverter conv(channels);
+    testConversion(conv);
+
+    // per channel calibration
+    conv.setCalibration(0, 1.05f, 12.0f);
+    conv.setCalibration(1, 0.97f, -8.5f);
+    conv.setCalibration(2, -1.0f, 4095.0f);
+    conv.setVdda(3250);
+    testConversion(conv);
+
+    // the Q15 output saturates with big gains
+    conv.setCalibration(0, 10.0f);
+    conv.setCalibration(1, 10.0f);
+    testConversion(conv);
+    int16_t in[2] = {4095, 0};
+    int16_t out[2];
+    conv.convert(in, out, 2);
+    TEST_CHECK(out[0] == 32767, "saturation high: %d", out[0]);
+    TEST_CHECK(out[1] == -32768, "saturation low: %d", out[1]);
+
+    // unsupported gain and channel
+    TEST_CHECK(!conv.setCalibration(0, 40.0f), "gain 40 accepted");
+    TEST_CHECK(!conv.setCalibration(channels, 1.0f), "invalid channel accepted");
+
+    // VDDA from the internal reference
+    TEST_CHECK(conv.setVddaFromVrefint(1500) && fabs(conv.vdda() - 3300.0f) < 0.01f, "vdda %f", conv.vdda());
+    TEST_CHECK(conv.setVddaFromVrefint(1650) && fabs(conv.vdda() - 3000.0f) < 0.01f, "vdda %f", conv.vdda());
+    TEST_CHECK(!conv.setVddaFromVrefint(0), "vrefint 0 accepted");
+
+    // VDDA outside of the supported range would overflow the microvolt coefficients with big gains
+    TEST_CHECK(conv.setCalibration(0, 32.0f), "gain 32 rejected");
+    TEST_CHECK(!conv.setVddaFromVrefint(1000), "vdda %f accepted", 3300.0f * 1500 / 1000);
+    TEST_CHECK(!conv.setVdda(1000), "vdda 1000 accepted");
+    TEST_CHECK(fabs(conv.vdda() - 3000.0f) < 0.01f, "vdda changed to %f", conv.vdda());
+    TEST_CHECK(conv.setVdda(ADC_CONVERTER_MAX_VDDA), "max vdda rejected");
+    testConversion(conv);
+    int16_t max_raw = 4095;
+    int32_t max_uv;
+    conv.convert(&max_raw, &max_uv, 1);
+    TEST_CHECK(max_uv > 0 && fabs(max_uv - 4095.0 * 32.0 * ADC_CONVERTER_MAX_VDDA / 4095.0 * 1000.0) <= 2.0, "max uv %d", max_uv);
+
+    // scalar host benchmark of the kernels
+    benchmark("ADCConverter Q15", samples, [&](){ conv.convert(raw, q15, samples); });
+    benchmark("ADCConverter int32 (uV)", samples, [&](){ conv.convert(raw, uv, samples); });
+    benchmark("ADCConverter float (mV)", samples, [&](){ conv.convert(raw, mv, samples); });
+
+    printf("ADCConverterTest: %s\n", test_failures==0 ? "OK" : "FAILED");
+    return test_failures==0 ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+// Host test of the ADCFilter against a double precision reference
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <type_traits>
+#include "ADCFilter.h"
+#include "Benchmark.h"
+
+const int channels = 2;
+// 2 seconds at 44100 Hz so that the 50 Hz notch has settled
+const int frames = 88200;
+const int samples = frames * channels;
+const int block = 256 * channels;
+static int16_t input[samples];
+static int16_t output[samples];
+static double reference[samples];
+
+static_assert(!std::is_copy_constructible<ADCFilter>::value, "ADCFilter must not be copyable");
+
+/// Direct Form I cascade in double precision for every channel
+void filterReference(const ADCBiquadCoefficients *coef, int stages){
+    for (int ch=0; ch<channels; ch++){
+        for (int j=ch; j<samples; j+=channels){
+            reference[j] = input[j];
+        }
+        for (int stage=0; stage<stages; stage++){
+            const ADCBiquadCoefficients &c = coef[stage];
+            double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+            for (int j=ch; j<samples; j+=channels){
+                double x0 = reference[j];
+                double y0 = c.b0 * x0 + c.b1 * x1 + c.b2 * x2 - c.a1 * y1 - c.a2 * y2;
+                x2 = x1;
+                x1 = x0;
+                y2 = y1;
+                y1 = y0;
+                reference[j] = y0;
+            }
+        }
+    }
+}
+
+/// Filters the input in DMA sized blocks
+void filterBlocks(ADCFilter &filter){
+    for (int j=0; j<samples; j++){
+        output[j] = input[j];
+    }
+    for (int j=0; j<samples; j+=block){
+        filter.process(output + j, (samples - j) < block ? samples - j : block);
+    }
+}
+
+/// Max absolute difference of the second half (after settling) to the reference
+double maxError(){
+    double result = 0;
+    for (int j=samples/2; j<samples; j++){
+        result = fmax(result, fabs(output[j] - reference[j]));
+    }
+    return result;
+}
+
+/// Max absolute output value in the second half
+double maxAmplitude(int ch){
+    double result = 0;
+    for (int j=samples/2 + ch; j<samples; j+=channels){
+        result = fmax(result, fabs(output[j]));
+    }
+    return result;
+}
+
+void createInput(float sampleRate, float amplitude, float freq1, float freq2){
+    for (int j=0; j<frames; j++){
+        double t = j / sampleRate;
+        input[j*channels] = (int16_t) lround(amplitude * sin(2 * ADC_FILTER_PI * freq1 * t));
+        input[j*channels+1] = (int16_t) lround(amplitude * 0.5 * sin(2 * ADC_FILTER_PI * freq1 * t) + amplitude * 0.5 * sin(2 * ADC_FILTER_PI * freq2 * t));
+    }
+}
+
+void testCascade(const char* name, float sampleRate, const ADCBiquadCoefficients *coef, int stages, ADCFilter::ADCFilterType type, double maxErr){
+    ADCFilter filter(channels, stages, type);
+    for (int stage=0; stage<stages; stage++){
+        TEST_CHECK(filter.setCoefficients(stage, coef[stage]), "%s: coefficients rejected", name);
+    }
+    createInput(sampleRate, 10000, 50, 1000);
+    filterReference(coef, stages);
+    filterBlocks(filter);
+    double err = maxError();
+    printf("%-30s max error %8.3f\n", name, err);
+    TEST_CHECK(err <= maxErr, "%s: max error %f > %f", name, err, maxErr);
+}
+
+void testNotch(float sampleRate){
+    ADCFilter filter(channels);
+    TEST_CHECK(filter.setCoefficients(0, ADCBiquadCoefficients::notch(sampleRate, 50)), "notch rejected");
+    createInput(sampleRate, 1000, 50, 50);
+    filterBlocks(filter);
+    printf("Q31 notch 50 Hz at %5.0f Hz  remaining amplitude %5.1f\n", sampleRate, maxAmplitude(0));
+    TEST_CHECK(maxAmplitude(0) <= 3, "notch at %f: amplitude %f", sampleRate, maxAmplitude(0));
+
+    // Q14 coefficients can not represent the notch
+    ADCFilter filter15(channels, 1, ADCFilter::Q15);
+    TEST_CHECK(!filter15.setCoefficients(0, ADCBiquadCoefficients::notch(sampleRate, 50)), "Q15 notch at %f accepted", sampleRate);
+}
+
+void testSaturation(ADCFilter::ADCFilterType type, double maxErr){
+    // resonant low pass with a full scale square wave overshoots
+    ADCFilter filter(channels, 1, type);
+    ADCBiquadCoefficients lp = ADCBiquadCoefficients::lowPass(8000, 500, 5.0f);
+    TEST_CHECK(filter.setCoefficients(0, lp), "low pass rejected");
+    for (int j=0; j<samples; j++){
+        input[j] = (j / channels / 40) % 2 ? 32767 : -32768;
+    }
+    filterReference(&lp, 1);
+    filterBlocks(filter);
+    // up to the first overshoot the result must follow the clamped reference and must not wrap around
+    for (int j=0; j<samples; j+=channels){
+        double expected = fmin(32767.0, fmax(-32768.0, reference[j]));
+        TEST_CHECK(fabs(output[j] - expected) <= maxErr, "saturation %d: %d != %f", j, output[j], expected);
+        if (reference[j]>32767.0 || reference[j]<-32768.0) break;
+    }
+}
+
+int main(){
+    ADCBiquadCoefficients notch = ADCBiquadCoefficients::notch(8000, 1000, 2.0f);
+    ADCBiquadCoefficients lp = ADCBiquadCoefficients::lowPass(8000, 2000);
+    ADCBiquadCoefficients hp = ADCBiquadCoefficients::highPass(8000, 300);
+    ADCBiquadCoefficients bp = ADCBiquadCoefficients::bandPass(8000, 1000, 2.0f);
+    ADCBiquadCoefficients cascade[] = {ADCBiquadCoefficients::notch(44100, 50), ADCBiquadCoefficients::lowPass(44100, 3000)};
+
+    testCascade("Q31 notch 1000 Hz", 8000, &notch, 1, ADCFilter::Q31, 2);
+    testCascade("Q31 low pass", 8000, &lp, 1, ADCFilter::Q31, 2);
+    testCascade("Q31 high pass", 8000, &hp, 1, ADCFilter::Q31, 2);
+    testCascade("Q31 band pass", 8000, &bp, 1, ADCFilter::Q31, 2);
+    testCascade("Q31 notch 50 Hz + low pass", 44100, cascade, 2, ADCFilter::Q31, 3);
+    // Q15 bounds: measured error plus a small margin so that a broken state update or rounding is detected
+    testCascade("Q15 notch 1000 Hz", 8000, &notch, 1, ADCFilter::Q15, 4);
+    testCascade("Q15 low pass", 8000, &lp, 1, ADCFilter::Q15, 2);
+    testCascade("Q15 high pass", 8000, &hp, 1, ADCFilter::Q15, 24);
+    testCascade("Q15 band pass", 8000, &bp, 1, ADCFilter::Q15, 4);
+    testNotch(8000);
+    testNotch(44100);
+    testSaturation(ADCFilter::Q15, 50);
+    testSaturation(ADCFilter::Q31, 2);
+
+    // invalid arguments
+    ADCFilter filter(channels, 2);
+    TEST_CHECK(!filter.setCoefficients(channels, 0, lp), "invalid channel accepted");
+    TEST_CHECK(!filter.setCoefficients(0, 2, lp), "invalid stage accepted");
+
+    // scalar host benchmark of the kernels
+    createInput(8000, 10000, 50, 1000);
+    ADCFilter q15(channels, 1, ADCFilter::Q15);
+    ADCFilter q15x2(channels, 2, ADCFilter::Q15);
+    ADCFilter q31(channels, 1, ADCFilter::Q31);
+    ADCFilter q31x2(channels, 2, ADCFilter::Q31);
+    benchmark("ADCFilter Q15 1 stage", block, [&](){ q15.process(input, block); }, 10000);
+    benchmark("ADCFilter Q15 2 stages", block, [&](){ q15x2.process(input, block); }, 10000);
+    benchmark("ADCFilter Q31 1 stage", block, [&](){ q31.process(input, block); }, 10000);
+    benchmark("ADCFilter Q31 2 stages", block, [&](){ q31x2.process(input, block); }, 10000);
+
+    printf("ADCFilterTest: %s\n", test_failures==0 ? "OK" : "FAILED");
+    return test_failures==0 ? 0 : 1;
+}
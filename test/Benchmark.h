@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief Minimal host helpers for the tests: check macro and a cycle counter
+ */
+static int test_failures = 0;
+
+#define TEST_CHECK(cond, ...) \
+    do { if (!(cond)) { test_failures++; printf("FAILED %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+/// Provides the time stamp counter on x86 and nanoseconds on other hosts
+static inline uint64_t benchmarkTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/// Unit of benchmarkTicks()
+static inline const char* benchmarkUnit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+/// Calls the function repeatedly and reports the ticks per sample
+template <class F>
+double benchmark(const char* name, int samples, F f, int repeat=1000) {
+    f();
+    uint64_t start = benchmarkTicks();
+    for (int j=0; j<repeat; j++){
+        f();
+    }
+    double result = double(benchmarkTicks() - start) / repeat / samples;
+    printf("%-30s %8.2f %s/sample\n", name, result, benchmarkUnit());
+    return result;
+}
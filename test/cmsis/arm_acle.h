@@ -0,0 +1,11 @@
+#pragma once
+// Host emulation of the ACLE DSP intrinsics which are used by the kernels
+#include <stdint.h>
+
+static inline int32_t __smulwb(int32_t a, int32_t b){
+    return (int32_t)(((int64_t)a * (int16_t)b) >> 16);
+}
+
+static inline int32_t __smulwt(int32_t a, int32_t b){
+    return (int32_t)(((int64_t)a * (int16_t)(b >> 16)) >> 16);
+}
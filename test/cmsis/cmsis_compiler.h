@@ -0,0 +1,21 @@
+#pragma once
+// Host emulation of the CMSIS DSP intrinsics which are used by the kernels, so that the
+// __ARM_FEATURE_DSP code paths can be tested on the host
+#include <stdint.h>
+
+static inline int32_t __SSAT(int32_t value, uint32_t bits){
+    int32_t max = (1 << (bits - 1)) - 1;
+    int32_t min = -max - 1;
+    return value > max ? max : (value < min ? min : value);
+}
+
+static inline uint32_t __PKHBT(uint32_t op1, uint32_t op2, uint32_t shift){
+    return (op1 & 0x0000FFFFUL) | ((op2 << shift) & 0xFFFF0000UL);
+}
+
+static inline uint64_t __SMLALD(uint32_t op1, uint32_t op2, uint64_t acc){
+    int64_t result = (int64_t)acc;
+    result += (int64_t)(int16_t)op1 * (int16_t)op2;
+    result += (int64_t)(int16_t)(op1 >> 16) * (int16_t)(op2 >> 16);
+    return (uint64_t)result;
+}